@@ -4,6 +4,7 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <thread>
 
 template<std::forward_iterator Iterator, class Acc, class Mapping, class Op = std::plus<>>
 requires std::invocable<Mapping, std::iter_value_t<Iterator>>
@@ -22,3 +23,33 @@ std::vector<std::result_of_t<F(T const&)>> map(std::vector<T> const& v, F&& f) {
     std::transform(v.begin(), v.end(), std::back_inserter(ret), f);
     return ret;
 }
+
+// Splits [0, n) into contiguous chunks of at least min_chunk indices, one per hardware thread, and
+// calls f(t, first, last) for chunk t on its own thread. Returns the number of chunks.
+template<class F>
+requires std::invocable<F, size_t, size_t, size_t>
+size_t parallel_for(size_t n, F&& f, size_t min_chunk = 1) {
+    size_t const threads = std::clamp<size_t>(n / std::max<size_t>(min_chunk, 1), 1, std::max(1u, std::thread::hardware_concurrency()));
+    if (threads == 1) {
+        f(size_t{0}, size_t{0}, n);
+        return 1;
+    }
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            f(t, n*t/threads, n*(t+1)/threads);
+        });
+    }
+    return threads;
+}
+
+template<std::random_access_iterator Iterator, class Pred>
+requires std::predicate<Pred, std::iter_reference_t<Iterator>>
+size_t parallel_count_if(Iterator first, Iterator last, Pred&& pred, size_t min_chunk = 4096) {
+    std::vector<size_t> counts(std::max(1u, std::thread::hardware_concurrency()));
+    parallel_for(last - first, [&](size_t t, size_t begin, size_t end) {
+        counts[t] = std::count_if(first + begin, first + end, pred);
+    }, min_chunk);
+    return std::accumulate(counts.begin(), counts.end(), size_t{0});
+}
@@ -1,50 +1,73 @@
-#include "algorithm.hpp"
+#include "parse.hpp"
 #include <iostream>
+#include <string_view>
+#include <string>
 #include <vector>
 #include <numeric>
-#include <iterator>
+#include <queue>
+#include <functional>
+#include <algorithm>
 
-using input_type = std::vector<std::vector<long>>;
+// Keeps the k largest totals seen so far in a min-heap, so the smallest of them can be replaced.
+class top_k {
+public:
+    explicit top_k(size_t k)
+            : _k(k)
+    {}
 
-static input_type read_input(std::istream& is) {
-    input_type input;
-    std::string line;
-    std::vector<long> block;
-    while (std::getline(is, line)) {
-        if (!line.empty()) {
-            block.push_back(std::stol(line));
-        } else if (!block.empty()) {
-            input.push_back(std::move(block));
-            block = {};
+    void add(long total) {
+        if (_heap.size() < _k) {
+            _heap.push(total);
+        } else if (_k > 0 && total > _heap.top()) {
+            _heap.pop();
+            _heap.push(total);
         }
     }
-    if (!block.empty()) {
-        input.push_back(std::move(block));
+
+    // The kept totals, largest first.
+    std::vector<long> take() && {
+        std::vector<long> ret;
+        ret.reserve(_heap.size());
+        while (!_heap.empty()) {
+            ret.push_back(_heap.top());
+            _heap.pop();
+        }
+        std::reverse(ret.begin(), ret.end());
+        return ret;
     }
-    return input;
-}
 
-long total_calories(std::vector<long> const& elf) {
-    return std::accumulate(elf.begin(), elf.end(), 0L);
-}
+private:
+    size_t _k;
+    std::priority_queue<long, std::vector<long>, std::greater<>> _heap;
+};
 
-template<std::forward_iterator Iterator>
-Iterator take_n(size_t n, Iterator begin, Iterator end) {
-    for (size_t i = 0; i < n && begin != end; ++i, ++begin) {
+// Sums each elf's block while reading and returns the k largest totals, largest first.
+static std::vector<long> top_calories(std::istream& is, size_t k) {
+    top_k top(k);
+    long total = 0;
+    bool in_block = false;
+    for_each_line(is, [&](std::string_view line) {
+        if (!line.empty()) {
+            total += parse_int(line);
+            in_block = true;
+        } else if (in_block) {
+            top.add(total);
+            total = 0;
+            in_block = false;
+        }
+    });
+    if (in_block) {
+        top.add(total);
     }
-    return begin;
+    return std::move(top).take();
 }
 
 int main() {
-    auto input = read_input(std::cin);
-
-    auto calories = map(input, total_calories);
-
-    std::sort(calories.begin(), calories.end());
+    auto const calories = top_calories(std::cin, 3);
 
-    std::cout << (calories.empty() ? 0 : calories.back()) << "\n";
+    std::cout << (calories.empty() ? 0 : calories.front()) << "\n";
 
-    std::cout << std::accumulate(calories.rbegin(), take_n(3, calories.rbegin(), calories.rend()), 0L) << "\n";
+    std::cout << std::accumulate(calories.begin(), calories.end(), 0L) << "\n";
 
     return 0;
 }
@@ -1,6 +1,11 @@
 #include <iostream>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
 
 std::string read_input(std::istream& is) {
     std::string line;
@@ -8,23 +13,74 @@ std::string read_input(std::istream& is) {
     return line;
 }
 
-size_t count_different(std::string const& s) {
-    std::unordered_set<char> counts(s.begin(), s.end());
-    return counts.size();
-}
+// Finds the markers for several window lengths in one scan, fed one character at a time. For
+// every position it tracks the longest run of distinct characters ending there, via the last
+// position each character was seen; a length's marker is the first position where that run
+// reaches it. Memory use is constant, so the signal can be streamed.
+class marker_scanner {
+public:
+    explicit marker_scanner(std::vector<size_t> const& lens)
+            : _lens(lens)
+            , _markers(lens.size(), std::string::npos)
+            , _order(lens.size())
+    {
+        std::iota(_order.begin(), _order.end(), 0);
+        std::sort(_order.begin(), _order.end(), [&](size_t i, size_t j) { return _lens[i] < _lens[j]; });
+        for (; _next < _order.size() && _lens[_order[_next]] == 0; ++_next) {
+            _markers[_order[_next]] = 0;
+        }
+    }
 
-size_t find_marker(std::string const& s, size_t len) {
-    for (size_t i = 0; i + len < s.size(); ++i) {
-        if (count_different(s.substr(i, len)) == len) {
-            return i + len;
+    [[nodiscard]] bool done() const {
+        return _next == _order.size();
+    }
+
+    void push(char c) {
+        size_t& last = _seen[static_cast<unsigned char>(c)];
+        _run_start = std::max(_run_start, last);
+        last = ++_pos;
+        for (; _next < _order.size() && _lens[_order[_next]] <= _pos - _run_start; ++_next) {
+            _markers[_order[_next]] = _pos;
         }
     }
-    return std::string::npos;
+
+    // Marker positions in the order the lengths were given, npos for those not found.
+    [[nodiscard]] std::vector<size_t> const& markers() const {
+        return _markers;
+    }
+
+private:
+    std::vector<size_t> _lens;
+    std::vector<size_t> _markers;
+    std::vector<size_t> _order;
+    size_t _next = 0;
+    std::array<size_t, 256> _seen{};  // Last position plus one, so zero means never seen.
+    size_t _pos = 0;
+    size_t _run_start = 0;
+};
+
+std::vector<size_t> find_markers(std::string_view s, std::vector<size_t> const& lens) {
+    marker_scanner scanner(lens);
+    for (size_t i = 0; i < s.size() && !scanner.done(); ++i) {
+        scanner.push(s[i]);
+    }
+    return scanner.markers();
+}
+
+// As above, but reads the first line of the signal straight from a stream.
+std::vector<size_t> find_markers(std::istream& is, std::vector<size_t> const& lens) {
+    marker_scanner scanner(lens);
+    for (std::istreambuf_iterator<char> it{is}, end{}; it != end && *it != '\n' && !scanner.done(); ++it) {
+        scanner.push(*it);
+    }
+    return scanner.markers();
 }
 
-int main() {
-    std::string const input = read_input(std::cin);
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "buffer";
+    std::vector<size_t> const lens = {4, 14};
 
-    std::cout << find_marker(input, 4) << "\n";
-    std::cout << find_marker(input, 14) << "\n";
+    auto const markers = mode == "stream" ? find_markers(std::cin, lens) : find_markers(read_input(std::cin), lens);
+    std::cout << markers[0] << "\n";
+    std::cout << markers[1] << "\n";
 }
@@ -1,9 +1,15 @@
 #include "grid.hpp"
+#include "algorithm.hpp"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
 
-grid<long> parse_input(std::istream& is) {
-    grid_builder<long> builder;
+using tree_grid = grid<uint8_t>;
+
+tree_grid parse_input(std::istream& is) {
+    grid_builder<uint8_t> builder;
     std::string line;
     while (std::getline(is, line)) {
         for (char c : line) {
@@ -31,62 +37,86 @@ requires std::is_convertible_v<std::iter_value_t<TreesIter>, long> &&
 void mark_visible(TreesIter begin, TreesIter end, VisibleIter visible, bool (visible_t::*mem_ptr)) {
     long highest = -1;
     for (; begin != end; ++begin, ++visible) {
-        if (*begin > highest) {
+        long const height = *begin;
+        if (height > highest) {
             (*visible).*mem_ptr = true;
         }
-        highest = std::max(highest, *begin);
+        highest = std::max(highest, height);
     }
 }
 
-grid<visible_t> mark_visible(grid<long> const& trees) {
+// Marks the trees in columns [first, last) visible from the north, or from the south when walking
+// the rows bottom-up. Rather than striding down each column, it walks whole rows and keeps a
+// running maximum per column, so all accesses are contiguous and the inner loop is a branch-free
+// max and compare that the compiler can vectorise. highest holds one plus the tallest tree so far.
+void mark_visible_vertical(tree_grid const& trees, grid<visible_t>& visible, long first, long last,
+                           bool (visible_t::*mem_ptr), bool bottom_up) {
+    if (first >= last) {
+        return;
+    }
+    std::vector<uint8_t> highest(last - first, 0);
+    for (long i = 0; i < trees.height(); ++i) {
+        long const y = bottom_up ? trees.height() - 1 - i : i;
+        uint8_t const* row = &trees.at(first, y);
+        visible_t* visible_row = &visible.at(first, y);
+        for (long x = 0; x < last - first; ++x) {
+            visible_row[x].*mem_ptr = row[x] >= highest[x];
+            highest[x] = std::max<uint8_t>(highest[x], row[x] + 1);
+        }
+    }
+}
+
+// The column sweeps, and then the row sweeps, are spread over threads. Each thread owns whole
+// columns or rows of visible, so no cell is written by two threads at once.
+grid<visible_t> mark_visible(tree_grid const& trees) {
     grid<visible_t> visible(trees.width(), trees.height());
 
     // From north/south
-    for (long x = 0; x < trees.width(); ++x) {
-        mark_visible(trees.col_begin(x), trees.col_end(x), visible.col_begin(x), &visible_t::visible_north);
-        mark_visible(trees.col_rbegin(x), trees.col_rend(x), visible.col_rbegin(x), &visible_t::visible_south);
-    }
+    parallel_for(trees.width(), [&](size_t, long first, long last) {
+        mark_visible_vertical(trees, visible, first, last, &visible_t::visible_north, false);
+        mark_visible_vertical(trees, visible, first, last, &visible_t::visible_south, true);
+    }, 64);
 
     // From west/east
-    for (long y = 0; y < trees.height(); ++y) {
-        mark_visible(trees.row_begin(y), trees.row_end(y), visible.row_begin(y), &visible_t::visible_west);
-        mark_visible(trees.row_rbegin(y), trees.row_rend(y), visible.row_rbegin(y), &visible_t::visible_east);
-    }
+    parallel_for(trees.height(), [&](size_t, long first, long last) {
+        for (long y = first; y < last; ++y) {
+            mark_visible(trees.row_begin(y), trees.row_end(y), visible.row_begin(y), &visible_t::visible_west);
+            mark_visible(trees.row_rbegin(y), trees.row_rend(y), visible.row_rbegin(y), &visible_t::visible_east);
+        }
+    }, 64);
 
     return visible;
 }
 
-template<class TreesIter>
-requires std::is_convertible_v<std::iter_value_t<TreesIter>, long>
-long scan(TreesIter begin, TreesIter end) {
-    if (begin == end) {
-        return 0;
-    }
-    long count = 0;
-    for (TreesIter it = begin+1; it != end; ++it) {
-        ++count;
-        if (*it >= *begin) {
-            break;
+// Multiplies each tree's viewing distance back towards begin into its score. The stack keeps
+// (position, height) of the trees with non-increasing heights, so once the shorter ones are popped
+// the top is the nearest tree blocking the view. Each tree is pushed and popped at most once.
+template<std::forward_iterator TreesIter, std::forward_iterator ScoreIter>
+requires std::is_convertible_v<std::iter_value_t<TreesIter>, long> &&
+         std::is_convertible_v<std::iter_reference_t<ScoreIter>, long&>
+void multiply_viewing_distances(TreesIter begin, TreesIter end, ScoreIter score, std::vector<std::pair<long, long>>& stack) {
+    stack.clear();
+    for (long i = 0; begin != end; ++begin, ++score, ++i) {
+        long const height = *begin;
+        while (!stack.empty() && stack.back().second < height) {
+            stack.pop_back();
         }
+        *score *= stack.empty() ? i : i - stack.back().first;
+        stack.emplace_back(i, height);
     }
-    return count;
 }
 
-long score_at(grid<long> const& trees, long x, long y) {
-    long const east = scan(trees.row_iter_at(x, y), trees.row_end(y));
-    long const west = scan(trees.row_riter_at(x, y), trees.row_rend(y));
-    long const south = scan(trees.col_iter_at(x, y), trees.col_end(x));
-    long const north = scan(trees.col_riter_at(x, y), trees.col_rend(x));
-    return east * west * north * south;
-}
-
-grid<long> scenic_scores(grid<long> const& trees) {
-    grid<long> scores(trees.width(), trees.height());
+grid<long> scenic_scores(tree_grid const& trees) {
+    grid<long> scores(trees.width(), trees.height(), 1);
+    std::vector<std::pair<long, long>> stack;
 
     for (long x = 0; x < trees.width(); ++x) {
-        for (long y = 0; y < trees.height(); ++y) {
-            scores.at(x, y) = score_at(trees, x, y);
-        }
+        multiply_viewing_distances(trees.col_begin(x), trees.col_end(x), scores.col_begin(x), stack);
+        multiply_viewing_distances(trees.col_rbegin(x), trees.col_rend(x), scores.col_rbegin(x), stack);
+    }
+    for (long y = 0; y < trees.height(); ++y) {
+        multiply_viewing_distances(trees.row_begin(y), trees.row_end(y), scores.row_begin(y), stack);
+        multiply_viewing_distances(trees.row_rbegin(y), trees.row_rend(y), scores.row_rbegin(y), stack);
     }
     return scores;
 }
@@ -101,5 +131,5 @@ int main() {
     }) << "\n";
     auto scores = scenic_scores(trees);
     auto it = std::max_element(scores.begin(), scores.end());
-    std::cout << (it == trees.end() ? -1 : *it) << "\n";
+    std::cout << (it == scores.end() ? -1 : *it) << "\n";
 }
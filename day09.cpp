@@ -1,6 +1,13 @@
+#include "parse.hpp"
 #include <iostream>
 #include <vector>
-#include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
 
 enum class dir_t {
     right,
@@ -28,14 +35,13 @@ dir_t parse_dir(char c) {
 
 std::vector<op_t> parse_input(std::istream& is) {
     std::vector<op_t> ops;
-    std::string line;
-    while (std::getline(is, line)) {
+    for_each_line(is, [&](std::string_view line) {
         if (line.size() < 3) {
             std::cerr << "Invalid line: " << line << std::endl;
         } else {
-            ops.push_back({parse_dir(line[0]), std::stol(line.substr(2))});
+            ops.push_back({parse_dir(line[0]), parse_int(line.substr(2))});
         }
-    }
+    });
     return ops;
 }
 
@@ -52,13 +58,6 @@ bool operator!=(coord_t p1, coord_t p2) {
     return !(p1 == p2);
 }
 
-struct coord_hash {
-    size_t operator()(coord_t const& p) const {
-        std::hash<long> h{};
-        return h(p.x ^ p.y);
-    }
-};
-
 struct rope_t {
     // First one is the head.
     std::vector<coord_t> knots;
@@ -104,30 +103,205 @@ coord_t follow(coord_t head_pos, coord_t tail_pos) {
     }
 }
 
-auto move(std::vector<op_t> const& ops, size_t rope_len) {
-    rope_t rope;
-    rope.knots.resize(rope_len);
-    std::unordered_set<coord_t, coord_hash> tail_positions = {{0,0}};
+struct bounds_t {
+    coord_t min;
+    coord_t max;
+};
+
+// Every knot only ever moves towards the one before it, so all knots stay inside the bounding box
+// of the head's path. Like move, an op with negative steps leaves the head where it is.
+bounds_t head_bounds(std::vector<op_t> const& ops) {
+    bounds_t bounds;
+    coord_t pos;
+    for (op_t op : ops) {
+        coord_t const delta = step({}, op.dir);
+        long const steps = std::max(op.steps, 0L);
+        pos = {pos.x + delta.x * steps, pos.y + delta.y * steps};
+        bounds.min = {std::min(bounds.min.x, pos.x), std::min(bounds.min.y, pos.y)};
+        bounds.max = {std::max(bounds.max.x, pos.x), std::max(bounds.max.y, pos.y)};
+    }
+    return bounds;
+}
+
+// A set of positions inside known bounds, stored as one bit per cell. Areas within max_dense_cells
+// get a single dense bitmap; larger ones are split into 64x64 tiles that are only allocated once
+// touched. Callers holding several sets should split the dense budget between them.
+class visited_set {
+public:
+    static constexpr long dense_budget = 1L << 30;
+
+    explicit visited_set(bounds_t bounds, long max_dense_cells = dense_budget)
+            : _min(bounds.min)
+            , _width(bounds.max.x - bounds.min.x + 1)
+    {
+        long const height = bounds.max.y - bounds.min.y + 1;
+        if (_width * height <= max_dense_cells) {
+            _dense.resize((_width * height + 63) / 64);
+        }
+    }
+
+    bool insert(coord_t pos) {
+        long const x = pos.x - _min.x;
+        long const y = pos.y - _min.y;
+        uint64_t* word;
+        uint64_t bit;
+        if (!_dense.empty()) {
+            long const i = y * _width + x;
+            word = &_dense[i / 64];
+            bit = uint64_t{1} << (i % 64);
+        } else {
+            tile_t& tile = tile_at(x / 64, y / 64);
+            word = &tile[y % 64];
+            bit = uint64_t{1} << (x % 64);
+        }
+        if (*word & bit) {
+            return false;
+        }
+        *word |= bit;
+        ++_size;
+        return true;
+    }
 
-    if (rope_len == 0) {
-        return tail_positions;
+    // Inserts every position on the axis-aligned segment from..to. Horizontal runs are set a word at
+    // a time; vertical ones fall back to single inserts.
+    void insert_segment(coord_t from, coord_t to) {
+        if (from.y != to.y) {
+            long const dy = from.y < to.y ? 1 : -1;
+            for (long y = from.y; y != to.y + dy; y += dy) {
+                insert({from.x, y});
+            }
+            return;
+        }
+        long x = std::min(from.x, to.x) - _min.x;
+        long const last = std::max(from.x, to.x) - _min.x;
+        long const y = from.y - _min.y;
+        while (x <= last) {
+            uint64_t* word;
+            long bit;
+            if (!_dense.empty()) {
+                long const i = y * _width + x;
+                word = &_dense[i / 64];
+                bit = i % 64;
+            } else {
+                word = &tile_at(x / 64, y / 64)[y % 64];
+                bit = x % 64;
+            }
+            long const count = std::min(64 - bit, last - x + 1);
+            uint64_t const mask = (count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1) << bit;
+            _size += std::popcount(mask & ~*word);
+            *word |= mask;
+            x += count;
+        }
+    }
+
+    [[nodiscard]] size_t size() const {
+        return _size;
+    }
+
+private:
+    using tile_t = std::array<uint64_t, 64>;
+
+    tile_t& tile_at(long tx, long ty) {
+        uint64_t const key = (static_cast<uint64_t>(tx) << 32) | static_cast<uint32_t>(ty);
+        if (!_last_tile || key != _last_key) {
+            auto& tile = _tiles[key];
+            if (!tile) {
+                tile = std::make_unique<tile_t>();
+            }
+            _last_tile = tile.get();
+            _last_key = key;
+        }
+        return *_last_tile;
+    }
+
+    coord_t _min;
+    long _width;
+    size_t _size = 0;
+    std::vector<uint64_t> _dense;
+    std::unordered_map<uint64_t, std::unique_ptr<tile_t>> _tiles;
+    tile_t* _last_tile = nullptr;
+    uint64_t _last_key = 0;
+};
+
+bool stretched(rope_t const& rope, coord_t delta) {
+    for (size_t i = 1; i < rope.knots.size(); ++i) {
+        if (rope.knots[i].x != rope.knots[i-1].x - delta.x || rope.knots[i].y != rope.knots[i-1].y - delta.y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Simulates a single rope as long as the longest requested one and records the positions visited
+// by the last knot of every requested length on the way, so all lengths share one traversal.
+std::map<size_t, visited_set> move(std::vector<op_t> const& ops, std::vector<size_t> const& rope_lens) {
+    bounds_t const bounds = head_bounds(ops);
+    std::vector<size_t> lens = rope_lens;
+    std::sort(lens.begin(), lens.end());
+    lens.erase(std::unique(lens.begin(), lens.end()), lens.end());
+    size_t const max_len = lens.empty() ? 0 : lens.back();
+
+    // All sets share one dense budget, so sweeping many lengths over a large area uses tiles.
+    long const max_dense_cells = visited_set::dense_budget / std::max<long>(lens.size(), 1);
+    std::map<size_t, visited_set> visited;
+    for (size_t len : lens) {
+        visited.try_emplace(len, bounds, max_dense_cells).first->second.insert({0, 0});
+    }
+
+    // The visited set of the knot ending a rope of each requested length, by knot index.
+    std::vector<visited_set*> knot_visited(max_len, nullptr);
+    for (auto& [len, positions] : visited) {
+        if (len > 0) {
+            knot_visited[len-1] = &positions;
+        }
+    }
+
+    rope_t rope;
+    rope.knots.resize(max_len);
+    if (max_len == 0) {
+        return visited;
     }
 
     for (op_t op : ops) {
+        coord_t const delta = step({}, op.dir);
         for (long s = 0; s < op.steps; ++s) {
+            // Once every knot trails the one before it in a straight line along the move, the whole
+            // rope just slides forward for the rest of the op.
+            if (stretched(rope, delta)) {
+                long const remaining = op.steps - s;
+                for (size_t i = 0; i < rope.knots.size(); ++i) {
+                    coord_t const first = {rope.knots[i].x + delta.x, rope.knots[i].y + delta.y};
+                    rope.knots[i] = {rope.knots[i].x + delta.x * remaining, rope.knots[i].y + delta.y * remaining};
+                    if (knot_visited[i]) {
+                        knot_visited[i]->insert_segment(first, rope.knots[i]);
+                    }
+                }
+                break;
+            }
             rope.knots.front() = step(rope.knots.front(), op.dir);
+            if (knot_visited.front()) {
+                knot_visited.front()->insert(rope.knots.front());
+            }
             for (size_t i = 1; i < rope.knots.size(); ++i) {
-                rope.knots[i] = follow(rope.knots[i-1], rope.knots[i]);
+                coord_t const next = follow(rope.knots[i-1], rope.knots[i]);
+                // A knot that stays put leaves all the ones after it in place too.
+                if (next == rope.knots[i]) {
+                    break;
+                }
+                rope.knots[i] = next;
+                if (knot_visited[i]) {
+                    knot_visited[i]->insert(next);
+                }
             }
-            tail_positions.insert(rope.knots.back());
         }
     }
-    return tail_positions;
+    return visited;
 }
 
 int main() {
     auto const input = parse_input(std::cin);
 
-    std::cout << move(input, 2).size() << "\n";
-    std::cout << move(input, 10).size() << "\n";
+    auto const visited = move(input, {2, 10});
+    std::cout << visited.at(2).size() << "\n";
+    std::cout << visited.at(10).size() << "\n";
 }
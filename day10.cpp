@@ -1,67 +1,210 @@
 #include "grid.hpp"
+#include "parse.hpp"
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <span>
+#include <ranges>
+#include <string_view>
+#include <optional>
 
-using op_t = long;
+enum class opcode_t {
+    noop,
+    addx,
+};
+
+struct op_t {
+    opcode_t opcode = opcode_t::noop;
+    long arg = 0;
+
+    [[nodiscard]] long cycles() const {
+        return opcode == opcode_t::addx ? 2 : 1;
+    }
+
+    [[nodiscard]] long delta() const {
+        return opcode == opcode_t::addx ? arg : 0;
+    }
+};
+
+// Parses a single line of the program; lines that are not instructions yield nothing.
+std::optional<op_t> parse_op(std::string_view line) {
+    if (line == "noop") {
+        return op_t{opcode_t::noop};
+    } else if (line.starts_with("addx ")) {
+        return op_t{opcode_t::addx, parse_int(line.substr(5))};
+    }
+    return std::nullopt;
+}
 
 std::vector<op_t> parse_input(std::istream& is) {
     std::vector<op_t> ops;
-    std::string line;
-    while (getline(is, line)) {
-        if (line == "noop") {
-            ops.push_back(0);
-        } else if (line.starts_with("addx ")) {
-            ops.push_back(std::stol(line.substr(5)));
+    for_each_line(is, [&](std::string_view line) {
+        if (auto const op = parse_op(line)) {
+            ops.push_back(*op);
         }
-    }
+    });
     return ops;
 }
 
-std::vector<long> process_signal(std::vector<op_t> const& ops) {
-    std::vector<long> signal;
-    long x = 1;
-    signal.push_back(x);
-    for (op_t op : ops) {
-        if (op == 0) {
-            signal.push_back(x);
-        } else {
-            signal.push_back(x);
-            x += op;
-            signal.push_back(x);
+// The CPU state while running a program: X and the number of cycles completed so far.
+class cpu {
+public:
+    // Runs a single op, calling on_cycle(cycle, x) for each of its cycles.
+    template<class Consumer>
+    void execute(op_t op, Consumer& on_cycle) {
+        for (long i = 0; i < op.cycles(); ++i) {
+            on_cycle(++_cycle, _x);
         }
+        _x += op.delta();
     }
-    return signal;
+
+    template<class Consumer>
+    void halt(Consumer& on_cycle) {
+        on_cycle(++_cycle, _x);
+    }
+
+private:
+    long _x = 1;
+    long _cycle = 0;
+};
+
+// Runs the program and calls on_cycle(cycle, x) with the value of X during every cycle, counting
+// cycles from 1. Nothing is stored, so memory use is independent of the program's length. The
+// stream ends with the cycle after the last op: a halted CPU produces no further cycles, so
+// consumers see nothing past it (the CRT leaves those pixels dark).
+template<std::ranges::input_range Ops, class Consumer>
+requires std::convertible_to<std::ranges::range_value_t<Ops>, op_t> && std::invocable<Consumer&, long, long>
+void run_signal(Ops&& ops, Consumer&& on_cycle) {
+    cpu state;
+    for (op_t op : ops) {
+        state.execute(op, on_cycle);
+    }
+    state.halt(on_cycle);
 }
 
-const size_t samples[] = {20, 60, 100, 140, 180, 220};
+// As above, but parses the program from a stream one line at a time as it runs, so it is never
+// held in memory.
+template<class Consumer>
+requires std::invocable<Consumer&, long, long>
+void run_signal(std::istream& is, Consumer&& on_cycle) {
+    cpu state;
+    for_each_line(is, [&](std::string_view line) {
+        if (auto const op = parse_op(line)) {
+            state.execute(*op, on_cycle);
+        }
+    });
+    state.halt(on_cycle);
+}
 
-grid<char> draw_signal(std::vector<long> const& signal) {
-    grid<char> screen(40, 6);
-    for (long y = 0; y < screen.height(); ++y) {
-        for (long x = 0; x < screen.width(); ++x) {
-            auto const i = static_cast<size_t>(y*screen.width() + x);
-            long const reg = signal.at(i);
-            if (reg-1 <= x && x <= reg+1) {
-                screen.at(x, y) = '#';
-            } else {
-                screen.at(x, y) = ' ';
+// The program folded into runs of cycles during which X is constant. Consecutive ops that leave X
+// unchanged share a run, and X during any cycle is found by binary search over the run starts.
+class compiled_program {
+public:
+    explicit compiled_program(std::vector<op_t> const& ops) {
+        long x = 1;
+        long start = 1;
+        long cycles = 0;
+        for (op_t op : ops) {
+            cycles += op.cycles();
+            if (op.delta() != 0) {
+                _starts.push_back(start);
+                _xs.push_back(x);
+                start += cycles;
+                cycles = 0;
+                x += op.delta();
             }
         }
+        // Unlike run_signal, queries past the end of the program are answered: X keeps the value
+        // it had when the program halted.
+        _starts.push_back(start);
+        _xs.push_back(x);
     }
-    return screen;
-}
 
-int main() {
-    auto const ops = parse_input(std::cin);
-    auto const signal = process_signal(ops);
+    [[nodiscard]] long x_at(long cycle) const {
+        auto it = std::upper_bound(_starts.begin(), _starts.end(), cycle);
+        if (it == _starts.begin()) {
+            throw std::out_of_range("cycles start at 1: " + std::to_string(cycle));
+        }
+        return _xs[it - _starts.begin() - 1];
+    }
+
+private:
+    std::vector<long> _starts;
+    std::vector<long> _xs;
+};
+
+class signal_sampler {
+public:
+    explicit signal_sampler(std::span<long const> samples)
+            : _samples(samples)
+    {}
+
+    void operator()(long cycle, long x) {
+        if (_next < _samples.size() && _samples[_next] == cycle) {
+            _sum += cycle * x;
+            ++_next;
+        }
+    }
+
+    [[nodiscard]] long sum() const {
+        return _sum;
+    }
+
+private:
+    std::span<long const> _samples;
+    size_t _next = 0;
+    long _sum = 0;
+};
 
-    long sum = 0;
-    for (size_t i : samples) {
-        sum += signal.at(i-1) * i;
+class crt {
+public:
+    crt(size_t width, size_t height)
+            : _screen(width, height, ' ')
+    {}
+
+    void operator()(long cycle, long x) {
+        long const i = cycle - 1;
+        if (i < _screen.width() * _screen.height()) {
+            long const col = i % _screen.width();
+            if (x-1 <= col && col <= x+1) {
+                _screen.at(col, i / _screen.width()) = '#';
+            }
+        }
+    }
+
+    [[nodiscard]] grid<char> const& screen() const {
+        return _screen;
+    }
+
+private:
+    grid<char> _screen;
+};
+
+const long samples[] = {20, 60, 100, 140, 180, 220};
+
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "compiled";
+    crt display(40, 6);
+    if (mode == "stream") {
+        signal_sampler sampler(samples);
+        run_signal(std::cin, [&](long cycle, long x) {
+            sampler(cycle, x);
+            display(cycle, x);
+        });
+        std::cout << sampler.sum() << "\n";
+    } else {
+        auto const ops = parse_input(std::cin);
+        compiled_program const program(ops);
+        long sum = 0;
+        for (long i : samples) {
+            sum += program.x_at(i) * i;
+        }
+        std::cout << sum << "\n";
+        run_signal(ops, display);
     }
-    std::cout << sum << "\n";
 
-    auto const screen = draw_signal(signal);
+    auto const& screen = display.screen();
     for (long y = 0; y < screen.height(); ++y) {
         for (long x = 0; x < screen.width(); ++x) {
             std::cout << screen.at(x, y);
@@ -4,6 +4,8 @@
 #include <queue>
 #include <limits>
 #include <functional>
+#include <string_view>
+#include <cstdlib>
 
 struct coord {
     long x;
@@ -111,13 +113,106 @@ grid<long> dijkstra(grid<long> const& map, coord start, std::function<bool(coord
     return distance;
 }
 
-int main() {
+constexpr long unreachable = std::numeric_limits<long>::max();
+
+long manhattan(coord p, coord q) {
+    return std::abs(p.x - q.x) + std::abs(p.y - q.y);
+}
+
+long astar(grid<long> const& map, coord start, coord end,
+           std::function<bool(coord, coord)> const& filter,
+           std::function<long(coord)> const& heuristic) {
+    grid<long> distance(map.width(), map.height(), unreachable);
+    priority_queue<long, coord> pq;
+    distance.at(start.x, start.y) = 0;
+    pq.push(heuristic(start), start);
+
+    while (!pq.empty()) {
+        auto [estimate, pos] = pq.pop();
+        long dist = distance.at(pos.x, pos.y);
+        if (pos.x == end.x && pos.y == end.y) {
+            return dist;
+        }
+        if (estimate > dist + heuristic(pos)) {
+            continue;
+        }
+        for (auto n : neighbours(pos, map.width(), map.height())) {
+            if (filter(pos, n) && distance.at(n.x, n.y) > dist+1) {
+                distance.at(n.x, n.y) = dist+1;
+                pq.push(dist+1 + heuristic(n), n);
+            }
+        }
+    }
+    return unreachable;
+}
+
+long shortest_distance(grid<long> const& map, coord start, coord end, std::function<bool(coord, coord)> const& filter) {
+    return astar(map, start, end, filter, [](coord) { return 0L; });
+}
+
+long bidirectional_bfs(grid<long> const& map, coord start, coord end, std::function<bool(coord, coord)> const& filter) {
+    if (start.x == end.x && start.y == end.y) {
+        return 0;
+    }
+    grid<long> forward(map.width(), map.height(), unreachable);
+    grid<long> backward(map.width(), map.height(), unreachable);
+    std::vector<coord> forward_frontier{start};
+    std::vector<coord> backward_frontier{end};
+    forward.at(start.x, start.y) = 0;
+    backward.at(end.x, end.y) = 0;
+
+    // Expand one full level of the smaller frontier at a time, so the first level where the
+    // searches meet yields the shortest total distance.
+    while (!forward_frontier.empty() && !backward_frontier.empty()) {
+        bool expand_forward = forward_frontier.size() <= backward_frontier.size();
+        auto& frontier = expand_forward ? forward_frontier : backward_frontier;
+        auto& own = expand_forward ? forward : backward;
+        auto& other = expand_forward ? backward : forward;
+
+        long best = unreachable;
+        std::vector<coord> next;
+        for (auto pos : frontier) {
+            long dist = own.at(pos.x, pos.y);
+            for (auto n : neighbours(pos, map.width(), map.height())) {
+                if (!(expand_forward ? filter(pos, n) : filter(n, pos))) {
+                    continue;
+                }
+                if (other.at(n.x, n.y) != unreachable) {
+                    best = std::min(best, dist+1 + other.at(n.x, n.y));
+                }
+                if (own.at(n.x, n.y) == unreachable) {
+                    own.at(n.x, n.y) = dist+1;
+                    next.push_back(n);
+                }
+            }
+        }
+        if (best != unreachable) {
+            return best;
+        }
+        frontier = std::move(next);
+    }
+    return unreachable;
+}
+
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "astar";
     auto const [map, start, end] = parse_input(std::cin);
 
-    auto distances = dijkstra(map, start, [&](coord src, coord dst) {
+    auto climbable = [&](coord src, coord dst) {
         return map.at(dst.x, dst.y) <= map.at(src.x, src.y)+1;
-    });
-    std::cout << distances.at(end.x, end.y) << "\n";
+    };
+    if (mode == "dijkstra") {
+        std::cout << dijkstra(map, start, climbable).at(end.x, end.y) << "\n";
+    } else if (mode == "early") {
+        std::cout << shortest_distance(map, start, end, climbable) << "\n";
+    } else if (mode == "bidir") {
+        std::cout << bidirectional_bfs(map, start, end, climbable) << "\n";
+    } else {
+        // Each step covers one cell and climbs at most one level, so both bounds are admissible.
+        std::cout << astar(map, start, end, climbable, [&](coord pos) {
+            return std::max(manhattan(pos, end), map.at(end.x, end.y) - map.at(pos.x, pos.y));
+        }) << "\n";
+    }
 
     auto reverse_distances = dijkstra(map, end, [&](coord src, coord dst) {
         return map.at(dst.x, dst.y)+1 >= map.at(src.x, src.y);
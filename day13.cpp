@@ -1,165 +1,278 @@
+#include "algorithm.hpp"
 #include <iostream>
 #include <vector>
-#include <variant>
-#include <memory>
+#include <string>
 #include <algorithm>
+#include <string_view>
+#include <stdexcept>
+#include <cctype>
 
-struct msg;
-using msg_vector = std::vector<msg>;
-
-struct msg {
-    explicit msg(long x): elem(x) {}
-    explicit msg(msg_vector v): elem(std::move(v)) {}
-    msg(): elem(msg_vector{}) {}
+// All packets share one token arena. A list token records `end`, the index one past its last
+// descendant, so a whole sub-list can be skipped in one step; packets are handles to their root.
+struct token {
+    bool is_list;
+    long value;
+    size_t end;
+};
 
-    std::variant<long, msg_vector> elem;
+struct packet {
+    size_t root;
 };
 
-msg parse_msg(std::string const& line) {
-    if (line.empty() || line[0] != '[') {
-        throw std::invalid_argument("unexpected start of msg line: " + line);
-    }
-    msg ret;
-
-    std::vector<msg_vector*> stack = {&get<msg_vector>(ret.elem)};
-    size_t i = 1;
-    while (i < line.size() && !stack.empty()) {
-        msg_vector* cur_list = stack.back();
-        if (line[i] == ']') {
-            stack.pop_back();
-            ++i;
-        } else if(line[i] == ',') {
-            ++i;
-        } else if (line[i] == '[') {
-            cur_list->push_back(msg{});
-            msg_vector* new_list = &get<msg_vector>(cur_list->back().elem);
-            stack.push_back(new_list);
-            ++i;
-        } else if (std::isdigit(line[i])) {
-            long const x = std::stol(line.substr(i));
-            cur_list->push_back(msg{x});
-            while (i < line.size() && std::isdigit(line[i])) {
+class packet_arena {
+public:
+    packet add(std::string_view line) {
+        if (line.empty() || line[0] != '[') {
+            throw std::invalid_argument("unexpected start of packet line: " + std::string(line));
+        }
+        size_t const root = _tokens.size();
+        std::vector<size_t> open;
+        size_t i = 0;
+        while (i < line.size()) {
+            if (line[i] == '[') {
+                open.push_back(_tokens.size());
+                _tokens.push_back({true, 0, 0});
+                ++i;
+            } else if (line[i] == ']') {
+                if (open.empty()) {
+                    throw std::invalid_argument("unbalanced packet line: " + std::string(line));
+                }
+                _tokens[open.back()].end = _tokens.size();
+                open.pop_back();
+                ++i;
+            } else if (std::isdigit(line[i])) {
+                long x = 0;
+                while (i < line.size() && std::isdigit(line[i])) {
+                    x = 10*x + (line[i] - '0');
+                    ++i;
+                }
+                _tokens.push_back({false, x, 0});
+            } else {
                 ++i;
             }
         }
+        if (!open.empty()) {
+            throw std::invalid_argument("unbalanced packet line: " + std::string(line));
+        }
+        return {root};
+    }
+
+    [[nodiscard]] int compare(packet p1, packet p2) const {
+        // Element ranges [first, last) of the lists currently being compared on each side. An
+        // integer promoted to a list is the one-element range covering just itself.
+        struct state {
+            size_t first1, last1;
+            size_t first2, last2;
+        };
+        std::vector<state> stack = {{p1.root+1, _tokens[p1.root].end, p2.root+1, _tokens[p2.root].end}};
+
+        while (!stack.empty()) {
+            state& s = stack.back();
+            if (s.first1 != s.last1 && s.first2 != s.last2) {
+                size_t const i1 = s.first1;
+                size_t const i2 = s.first2;
+                token const& t1 = _tokens[i1];
+                token const& t2 = _tokens[i2];
+                s.first1 = next(i1);
+                s.first2 = next(i2);
+
+                if (!t1.is_list && !t2.is_list) {
+                    if (t1.value != t2.value) {
+                        return t1.value < t2.value ? -1 : 1;
+                    }
+                } else {
+                    stack.push_back({t1.is_list ? i1+1 : i1, next(i1), t2.is_list ? i2+1 : i2, next(i2)});
+                }
+            } else if (s.first2 != s.last2) {
+                return -1;
+            } else if (s.first1 != s.last1) {
+                return 1;
+            } else {
+                stack.pop_back();
+            }
+        }
+        return 0;
     }
-    return ret;
-}
 
-std::vector<std::pair<msg, msg>> parse_input(std::istream& is) {
-    std::vector<std::pair<msg, msg>> msgs;
+private:
+    [[nodiscard]] size_t next(size_t i) const {
+        return _tokens[i].is_list ? _tokens[i].end : i+1;
+    }
+
+    std::vector<token> _tokens;
+};
+
+using packet_pair = std::pair<std::string, std::string>;
+
+std::vector<packet_pair> parse_input(std::istream& is) {
+    std::vector<packet_pair> packets;
 
     std::string line;
     while(std::getline(is, line)) {
-        auto msg1 = parse_msg(line);
+        std::string packet1 = std::move(line);
         std::getline(is, line);
-        auto msg2 = parse_msg(line);
+        std::string packet2 = std::move(line);
         std::getline(is, line);
-        msgs.emplace_back(std::move(msg1), std::move(msg2));
+        packets.emplace_back(std::move(packet1), std::move(packet2));
     }
-    return msgs;
+    return packets;
 }
 
-int compare(msg const& m1, msg const& m2) {
-    if (get_if<long>(&m1.elem) || get_if<long>(&m2.elem)) {
-        throw std::invalid_argument("can only compare root msg vectors");
+// Walks a packet's text token by token. An integer compared against a list is promoted lexically:
+// the cursor stays on the integer, and once it has been consumed the matching number of virtual
+// closing brackets are produced before reading on.
+class raw_cursor {
+public:
+    explicit raw_cursor(std::string_view s): _s(s) {}
+
+    [[nodiscard]] char peek() {
+        if (_pending_close > 0) {
+            return ']';
+        }
+        while (_i < _s.size() && _s[_i] == ',') {
+            ++_i;
+        }
+        if (_i >= _s.size()) {
+            return '\0';
+        }
+        return std::isdigit(_s[_i]) ? '0' : _s[_i];
+    }
+
+    long number() const {
+        long x = 0;
+        for (size_t i = _i; i < _s.size() && std::isdigit(_s[i]); ++i) {
+            x = 10*x + (_s[i] - '0');
+        }
+        return x;
     }
 
-    using iterator = msg_vector::const_iterator;
-
-    struct state {
-        explicit state(msg_vector const& v): first(v.begin()), last(v.end()) {}
-        explicit state(iterator f, iterator l): first(f), last(l) {}
-        iterator first;
-        iterator last;
-    };
-    std::vector<state> stack1 = {state{std::get<msg_vector>(m1.elem)}};
-    std::vector<state> stack2 = {state{std::get<msg_vector>(m2.elem)}};
-
-    while (!stack1.empty() && !stack2.empty()) {
-        state& state1 = stack1.back();
-        state& state2 = stack2.back();
-
-        if (state1.first != state1.last && state2.first != state2.last) {
-            long const* val1 = get_if<long>(&state1.first->elem);
-            long const* val2 = get_if<long>(&state2.first->elem);
-            msg_vector const* vec1 = get_if<msg_vector>(&state1.first->elem);
-            msg_vector const* vec2 = get_if<msg_vector>(&state2.first->elem);
-
-            // Careful, so we don't invalidate pointers.
-            auto first1 = state1.first;
-            auto first2 = state2.first;
-            ++state1.first;
-            ++state2.first;
-
-            if (val1 && val2) {
-                if (*val1 < *val2) {
-                    return -1;
-                } else if(*val1 > *val2) {
-                    return 1;
-                }
-            } else if (val1 && vec2) {
-                stack1.emplace_back(first1, first1+1);
-                stack2.emplace_back(*vec2);
-            } else if (vec1 && val2) {
-                stack1.emplace_back(*vec1);
-                stack2.emplace_back(first2, first2+1);
-            } else {
-                stack1.emplace_back(*vec1);
-                stack2.emplace_back(*vec2);
+    void promote() {
+        ++_wrap;
+    }
+
+    void next() {
+        if (_pending_close > 0) {
+            --_pending_close;
+        } else if (std::isdigit(_s[_i])) {
+            while (_i < _s.size() && std::isdigit(_s[_i])) {
+                ++_i;
             }
-        } else if (state2.first != state2.last) {
+            _pending_close = _wrap;
+            _wrap = 0;
+        } else {
+            ++_i;
+        }
+    }
+
+private:
+    std::string_view _s;
+    size_t _i = 0;
+    long _wrap = 0;
+    long _pending_close = 0;
+};
+
+int compare_raw(std::string_view s1, std::string_view s2) {
+    raw_cursor c1{s1};
+    raw_cursor c2{s2};
+
+    while (true) {
+        char const t1 = c1.peek();
+        char const t2 = c2.peek();
+        if (t1 == '\0' || t2 == '\0') {
+            return t1 == t2 ? 0 : (t1 == '\0' ? -1 : 1);
+        } else if (t1 == '0' && t2 == '0') {
+            long const x1 = c1.number();
+            long const x2 = c2.number();
+            if (x1 != x2) {
+                return x1 < x2 ? -1 : 1;
+            }
+            c1.next();
+            c2.next();
+        } else if (t1 == t2) {
+            c1.next();
+            c2.next();
+        } else if (t1 == ']') {
             return -1;
-        } else if (state1.first != state1.last) {
+        } else if (t2 == ']') {
             return 1;
+        } else if (t1 == '0') {
+            c1.promote();
+            c2.next();
         } else {
-            stack1.pop_back();
-            stack2.pop_back();
+            c1.next();
+            c2.promote();
         }
     }
-    if (stack1.empty() && stack2.empty()) {
-        return 0;
-    } else if (stack1.empty()) {
-        return -1;
-    } else {
-        return 1;
-    }
 }
 
-std::strong_ordering operator<=>(msg const& m1, msg const& m2) {
-    return compare(m1, m2) <=> 0;
-}
-
-bool operator==(msg const& m1, msg const& m2) {
-    return compare(m1, m2) == 0;
+// Number of packets ordered strictly before key, i.e. key's zero-based position once sorted in.
+template<class Packet, class Compare>
+size_t rank_of(Packet const& key, std::vector<Packet> const& packets, Compare const& compare) {
+    return parallel_count_if(packets.begin(), packets.end(), [&](Packet const& p) {
+        return compare(p, key) < 0;
+    });
 }
 
 namespace {
-    msg const divider2 = msg(msg_vector{msg(msg_vector{msg(2)})});
-    msg const divider6 = msg(msg_vector{msg(msg_vector{msg(6)})});
+    std::string_view const raw_divider2 = "[[2]]";
+    std::string_view const raw_divider6 = "[[6]]";
 }
 
-int main() {
-    auto const input = parse_input(std::cin);
-
+void solve_raw(std::vector<packet_pair> const& input) {
     size_t index_sum = 0;
     for (size_t i = 0; i < input.size(); ++i) {
-        if (compare(input[i].first, input[i].second) <= 0) {
+        if (compare_raw(input[i].first, input[i].second) <= 0) {
             index_sum += (i+1);
         }
     }
     std::cout << index_sum << "\n";
 
-    std::vector<msg> all_messages = {divider2, divider6};
+    std::vector<std::string_view> all_packets;
+    all_packets.reserve(2*input.size());
     for (auto const& p : input) {
-        all_messages.push_back(p.first);
-        all_messages.push_back(p.second);
+        all_packets.emplace_back(p.first);
+        all_packets.emplace_back(p.second);
     }
-    std::sort(all_messages.begin(), all_messages.end());
 
-    auto it2 = std::find(all_messages.begin(), all_messages.end(), divider2);
-    auto it6 = std::find(all_messages.begin(), all_messages.end(), divider6);
-    size_t const index2 = (it2 - all_messages.begin())+1;
-    size_t const index6 = (it6 - all_messages.begin())+1;
+    // The dividers themselves are not in the list, and [[2]] always precedes [[6]].
+    size_t const index2 = rank_of(raw_divider2, all_packets, compare_raw)+1;
+    size_t const index6 = rank_of(raw_divider6, all_packets, compare_raw)+2;
     std::cout << (index2*index6) << "\n";
 }
+
+void solve_arena(std::vector<packet_pair> const& input) {
+    packet_arena arena;
+    packet const divider2 = arena.add(raw_divider2);
+    packet const divider6 = arena.add(raw_divider6);
+
+    std::vector<packet> all_packets;
+    all_packets.reserve(2*input.size());
+    for (auto const& p : input) {
+        all_packets.push_back(arena.add(p.first));
+        all_packets.push_back(arena.add(p.second));
+    }
+
+    size_t index_sum = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (arena.compare(all_packets[2*i], all_packets[2*i+1]) <= 0) {
+            index_sum += (i+1);
+        }
+    }
+    std::cout << index_sum << "\n";
+
+    auto compare = [&](packet p1, packet p2) { return arena.compare(p1, p2); };
+    size_t const index2 = rank_of(divider2, all_packets, compare)+1;
+    size_t const index6 = rank_of(divider6, all_packets, compare)+2;
+    std::cout << (index2*index6) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "raw";
+    auto const input = parse_input(std::cin);
+
+    if (mode == "arena") {
+        solve_arena(input);
+    } else {
+        solve_raw(input);
+    }
+}
@@ -5,6 +5,9 @@
 #include <regex>
 #include <limits>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string_view>
 
 struct coord {
     long x = 0;
@@ -127,45 +130,145 @@ bool move(grid<char> const& map, long& x, long& y) {
     return false;
 }
 
-bool drop_sand_grain(offset_map& map, coord pos) {
-    long x = pos.x - map.offset.x;
-    long y = pos.y - map.offset.y;
+// Remembers the fall path of the previous grain. Everything on that path except its last cell is
+// still free, so the next grain resumes from the end of the path instead of from the source.
+class sand_simulator {
+public:
+    sand_simulator(offset_map& map, coord source)
+            : _map(map)
+            , _source{source.x - map.offset.x, source.y - map.offset.y}
+    {}
 
-    while (true) {
-        if (y+1 >= map.map.height()) {
-            return false;
+    // Drops one grain, returning false if it falls out of the map or the source is blocked.
+    bool drop() {
+        if (_path.empty()) {
+            if (_map.map.at(_source.x, _source.y) != 0) {
+                return false;
+            }
+            _path.push_back(_source);
         }
 
-        if (!move(map.map, x, y)) {
-            map.map.at(x, y) = 'o';
-            return true;
+        while (true) {
+            coord pos = _path.back();
+            if (pos.y+1 >= _map.map.height()) {
+                return false;
+            }
+
+            if (move(_map.map, pos.x, pos.y)) {
+                _path.push_back(pos);
+            } else {
+                _map.map.at(pos.x, pos.y) = 'o';
+                _path.pop_back();
+                return true;
+            }
         }
     }
-}
+
+private:
+    offset_map& _map;
+    coord _source;
+    std::vector<coord> _path;
+};
 
 size_t drop_until_done(offset_map& map, coord sand_pos) {
+    sand_simulator sim(map, sand_pos);
     size_t count = 0;
-    while (drop_sand_grain(map, sand_pos)) {
+    while (sim.drop()) {
         ++count;
     }
     return count;
 }
 
-size_t drop_until_blocked(offset_map& map, coord sand_pos) {
+using bit_row = std::vector<uint64_t>;
+
+void set_bits(bit_row& row, long first, long last) {
+    for (long i = first; i <= last; ++i) {
+        row[i / 64] |= uint64_t{1} << (i % 64);
+    }
+}
+
+// Every cell that can hold sand: a cell and its two diagonal neighbours, shifted down one row.
+void spread(bit_row const& row, bit_row& next) {
+    for (size_t i = 0; i < row.size(); ++i) {
+        uint64_t const from_left = (row[i] << 1) | (i > 0 ? row[i-1] >> 63 : 0);
+        uint64_t const from_right = (row[i] >> 1) | (i+1 < row.size() ? row[i+1] << 63 : 0);
+        next[i] = row[i] | from_left | from_right;
+    }
+}
+
+// With a floor, the resting sand is exactly the set of cells reachable from the source, so it can
+// be swept one row at a time: a cell holds sand if one of the three cells above it does and it is
+// not rock. Rocks are painted per row from the segments spanning it, so memory is one row.
+size_t count_reachable_sand(std::vector<trace> const& traces, coord source) {
+    struct segment {
+        coord from;
+        coord to;
+    };
+    std::vector<segment> segments;
+    for (auto const& tr : traces) {
+        for (size_t i = 1; i < tr.size(); ++i) {
+            segments.push_back({{std::min(tr[i-1].x, tr[i].x), std::min(tr[i-1].y, tr[i].y)},
+                                {std::max(tr[i-1].x, tr[i].x), std::max(tr[i-1].y, tr[i].y)}});
+        }
+    }
+    std::sort(segments.begin(), segments.end(), [](segment const& s1, segment const& s2) {
+        return s1.from.y < s2.from.y;
+    });
+
+    long const floor_y = bounds(traces).second.y + 2;
+    long const depth = floor_y - source.y;
+    if (depth <= 0) {
+        return 0;
+    }
+    // Bit i of a row is x = left + i; sand can spread at most one column per row.
+    long const left = source.x - (depth - 1);
+    long const width = 2*depth - 1;
+    bit_row row((width + 63) / 64);
+    bit_row next(row.size());
+    bit_row rock(row.size());
+    std::vector<segment> active;
+    auto pending = segments.begin();
+
     size_t count = 0;
-    while (map.map.at(sand_pos.x - map.offset.x, sand_pos.y - map.offset.y) == 0) {
-        drop_sand_grain(map, sand_pos);
-        ++count;
+    for (long y = source.y; y < floor_y; ++y) {
+        while (pending != segments.end() && pending->from.y <= y) {
+            active.push_back(*pending++);
+        }
+        std::erase_if(active, [&](segment const& seg) { return seg.to.y < y; });
+
+        std::fill(rock.begin(), rock.end(), 0);
+        for (auto const& seg : active) {
+            long const first = std::max(seg.from.x - left, 0L);
+            long const last = std::min(seg.to.x - left, width - 1);
+            set_bits(rock, first, last);
+        }
+
+        if (y == source.y) {
+            std::fill(next.begin(), next.end(), 0);
+            set_bits(next, source.x - left, source.x - left);
+        } else {
+            spread(row, next);
+        }
+        for (size_t i = 0; i < next.size(); ++i) {
+            next[i] &= ~rock[i];
+            count += std::popcount(next[i]);
+        }
+        std::swap(row, next);
     }
     return count;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "sweep";
     auto traces = parse_input(std::cin);
     auto map = create_map(traces, false);
 
     std::cout << drop_until_done(map, {500, 0}) << "\n";
 
-    map = create_map(traces, true);
-    std::cout << drop_until_blocked(map, {500, 0}) << "\n";
+    if (mode == "simulate") {
+        map = create_map(traces, true);
+        std::cout << drop_until_done(map, {500, 0}) << "\n";
+    } else {
+        std::cout << count_reachable_sand(traces, {500, 0}) << "\n";
+    }
 }
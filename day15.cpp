@@ -6,6 +6,8 @@
 #include <cstdlib>
 #include <unordered_set>
 #include <algorithm>
+#include <atomic>
+#include <string_view>
 
 struct coord {
     long x = 0;
@@ -68,36 +70,24 @@ interval truncate(interval const& intvl1, interval const& intvl2) {
     return {std::max(intvl1.begin, intvl2.begin), std::min(intvl1.end, intvl2.end)};
 }
 
-interval overlap_union(interval const& intvl1, interval const& intvl2) {
-    return {std::min(intvl1.begin, intvl2.begin), std::max(intvl1.end, intvl2.end)};
-}
-
-class interval_union {
-public:
-    interval_union() = default;
-
-    void add(interval const& intvl) {
-        auto first = std::lower_bound(intervals.begin(), intervals.end(), intvl, [](interval const& el, interval const& intvl) {
-            return el.end < intvl.begin;
-        });
-        auto last = std::upper_bound(intervals.begin(), intervals.end(), intvl, [](interval const& intvl, interval const& el) {
-            return intvl.end < el.begin;
-        });
-        interval new_intvl = intvl;
-        for (auto it = first; it != last; ++it) {
-            new_intvl = overlap_union(new_intvl, *it);
+// Unites the non-empty intervals into out, sorted and disjoint. Sorts intervals in place and reuses
+// the storage of out, so callers can keep both buffers across rows without allocating.
+void unite(std::vector<interval>& intervals, std::vector<interval>& out) {
+    std::sort(intervals.begin(), intervals.end(), [](interval const& i1, interval const& i2) {
+        return i1.begin < i2.begin;
+    });
+    out.clear();
+    for (interval const& i : intervals) {
+        if (i.empty()) {
+            continue;
+        }
+        if (!out.empty() && i.begin <= out.back().end) {
+            out.back().end = std::max(out.back().end, i.end);
+        } else {
+            out.push_back(i);
         }
-        intervals.erase(first, last);
-        intervals.insert(first, new_intvl);
-    }
-
-    [[nodiscard]] std::vector<interval> get_intervals() const {
-        return intervals;
     }
-
-private:
-    std::vector<interval> intervals;
-};
+}
 
 interval cover_at_y(reading const& r, long y) {
     long const dy = labs(r.sensor.y - y);
@@ -111,14 +101,10 @@ interval cover_at_y(reading const& r, long y) {
 
 const long Y = 2'000'000;
 
-std::vector<interval> union_of(std::vector<interval> const& intervals) {
-    interval_union un;
-    for (interval const& i : intervals) {
-        if (!i.empty()) {
-            un.add(i);
-        }
-    }
-    return un.get_intervals();
+std::vector<interval> union_of(std::vector<interval> intervals) {
+    std::vector<interval> united;
+    unite(intervals, united);
+    return united;
 }
 
 size_t union_size(std::vector<interval> const& intervals) {
@@ -136,20 +122,21 @@ size_t unique_beacons_at(std::vector<reading> const& readings, long y) {
     return xs.size();
 }
 
-long scan_line(std::vector<interval> const& intervals, long y, long min_x, long max_x) {
+long scan_line(std::vector<interval> const& united, long y, long min_x, long max_x, bool diagnostics = true) {
     auto const max_size = static_cast<size_t>(max_x - min_x + 1);
 
-    std::vector<interval> const united = union_of(intervals);
     if (united.size() == 1) {
         interval const trunc = truncate(united[0], {min_x, max_x+1});
         if (trunc.size() == max_size - 1) {
-            std::cout << "Single point at border of y = " << y << "\n";
+            if (diagnostics) {
+                std::cout << "Single point at border of y = " << y << "\n";
+            }
             if (trunc.begin == min_x) {
                 return min_x;
             } else {
                 return max_x;
             }
-        } else if (trunc.size() < max_size - 1) {
+        } else if (trunc.size() < max_size - 1 && diagnostics) {
             std::cout << "Too few points at y = " << y << "\n";
         }
     } else if (united.size() == 2) {
@@ -157,19 +144,23 @@ long scan_line(std::vector<interval> const& intervals, long y, long min_x, long
         interval const trunc1 = truncate(united[1], {min_x, max_x+1});
         if (trunc0.size() + trunc1.size() == max_size - 1) {
             return united[0].end;
-        } else {
+        } else if (diagnostics) {
             std::cout << "Too many points (split in two) at y = " << y << "\n";
         }
-    } else if (united.size() > 1) {
+    } else if (united.size() > 1 && diagnostics) {
         std::cout << "Too many points at y = " << y << "\n";
     }
     return min_x-1;
 }
 
 coord find_unique_uncovered(std::vector<reading> const& readings, long min_y, long max_y, long min_x, long max_x) {
+    std::vector<interval> intervals(readings.size());
+    std::vector<interval> united;
+    united.reserve(readings.size());
     for (long y = min_y; y <= max_y; ++y) {
-        std::vector<interval> const intervals = map(readings, [y](reading const& r) { return cover_at_y(r, y);});
-        long x = scan_line(intervals, y, min_x, max_x);
+        std::transform(readings.begin(), readings.end(), intervals.begin(), [y](reading const& r) { return cover_at_y(r, y);});
+        unite(intervals, united);
+        long x = scan_line(united, y, min_x, max_x);
         if (x != min_x-1) {
             return {x, y};
         }
@@ -177,13 +168,94 @@ coord find_unique_uncovered(std::vector<reading> const& readings, long min_y, lo
     return {min_x-1, min_y-1};
 }
 
-int main() {
+// Splits the rows across threads. Each thread checks the shared flag between rows, so the others
+// stop soon after one of them finds the gap. Diagnostics are suppressed to keep output off the hot path.
+coord find_unique_uncovered_parallel(std::vector<reading> const& readings, long min_y, long max_y, long min_x, long max_x) {
+    std::atomic<bool> found = false;
+    coord result{min_x-1, min_y-1};
+    parallel_for(max_y - min_y + 1, [&](size_t, long first, long last) {
+        std::vector<interval> intervals(readings.size());
+        std::vector<interval> united;
+        united.reserve(readings.size());
+        for (long y = min_y + first; y < min_y + last && !found.load(std::memory_order_relaxed); ++y) {
+            std::transform(readings.begin(), readings.end(), intervals.begin(), [y](reading const& r) { return cover_at_y(r, y);});
+            unite(intervals, united);
+            long x = scan_line(united, y, min_x, max_x, false);
+            bool expected = false;
+            if (x != min_x-1 && found.compare_exchange_strong(expected, true)) {
+                result = {x, y};
+            }
+        }
+    });
+    return result;
+}
+
+bool covered(std::vector<reading> const& readings, coord pos) {
+    return std::any_of(readings.begin(), readings.end(), [&](reading const& r) {
+        return labs(pos.x - r.sensor.x) + labs(pos.y - r.sensor.y) <= r.mh_radius();
+    });
+}
+
+// In rotated coordinates u = x+y and v = x-y the diamond edges are the lines u = const and
+// v = const. The uncovered point is usually a crossing of two radius+1 edges, or of one such edge
+// with the search area border. It can also sit between two parallel radius+1 edges with the way
+// along them blocked by corners of diamonds whose radius+2 edges pass through it, so those lines
+// are included too. That keeps the candidates O(sensors^2) regardless of the search area size;
+// should none of them be uncovered anyway, this falls back to the quiet parallel row scan.
+coord find_uncovered_by_boundaries(std::vector<reading> const& readings, long min_y, long max_y, long min_x, long max_x) {
+    std::vector<long> us;
+    std::vector<long> vs;
+    for (auto const& r : readings) {
+        for (long const d : {r.mh_radius() + 1, r.mh_radius() + 2}) {
+            us.push_back(r.sensor.x + r.sensor.y - d);
+            us.push_back(r.sensor.x + r.sensor.y + d);
+            vs.push_back(r.sensor.x - r.sensor.y - d);
+            vs.push_back(r.sensor.x - r.sensor.y + d);
+        }
+    }
+
+    // Candidates are tested as they are generated, so nothing is stored and the search stops at
+    // the first uncovered one.
+    auto const uncovered = [&](coord c) {
+        return c.x >= min_x && c.x <= max_x && c.y >= min_y && c.y <= max_y && !covered(readings, c);
+    };
+    for (coord const c : {coord{min_x, min_y}, coord{min_x, max_y}, coord{max_x, min_y}, coord{max_x, max_y}}) {
+        if (uncovered(c)) {
+            return c;
+        }
+    }
+    for (long u : us) {
+        for (long v : vs) {
+            if ((u - v) % 2 == 0 && uncovered({(u + v) / 2, (u - v) / 2})) {
+                return {(u + v) / 2, (u - v) / 2};
+            }
+        }
+        for (coord const c : {coord{min_x, u - min_x}, coord{max_x, u - max_x}, coord{u - min_y, min_y}, coord{u - max_y, max_y}}) {
+            if (uncovered(c)) {
+                return c;
+            }
+        }
+    }
+    for (long v : vs) {
+        for (coord const c : {coord{min_x, min_x - v}, coord{max_x, max_x - v}, coord{v + min_y, min_y}, coord{v + max_y, max_y}}) {
+            if (uncovered(c)) {
+                return c;
+            }
+        }
+    }
+    return find_unique_uncovered_parallel(readings, min_y, max_y, min_x, max_x);
+}
+
+int main(int argc, char* argv[]) {
+    std::string_view const mode = argc > 1 ? argv[1] : "boundaries";
     auto input = parse_input(std::cin);
 
     std::vector<interval> const intervals = map(input, [](reading const& r) { return cover_at_y(r, Y);});
 
     std::cout << (union_size(intervals) - unique_beacons_at(input, Y)) << "\n";
 
-    auto const pos = find_unique_uncovered(input, 0, 4'000'000, 0, 4'000'000);
+    auto const pos = mode == "scan" ? find_unique_uncovered(input, 0, 4'000'000, 0, 4'000'000)
+            : mode == "parallel-scan" ? find_unique_uncovered_parallel(input, 0, 4'000'000, 0, 4'000'000)
+            : find_uncovered_by_boundaries(input, 0, 4'000'000, 0, 4'000'000);
     std::cout << (pos.x * 4'000'000 + pos.y) << "\n";
 }
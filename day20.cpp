@@ -1,4 +1,5 @@
 #include "algorithm.hpp"
+#include "parse.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -7,10 +8,9 @@
 
 std::vector<long> parse_input(std::istream& is) {
     std::vector<long> ret;
-    std::string line;
-    while (std::getline(is, line)) {
-        ret.push_back(std::stol(line));
-    }
+    for_each_line(is, [&](std::string_view line) {
+        ret.push_back(parse_int(line));
+    });
     return ret;
 }
 
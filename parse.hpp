@@ -0,0 +1,74 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <stdexcept>
+#include <system_error>
+
+// Parses an integer like std::stol, but straight from the characters: no string copy and no
+// locale lookup. Leading spaces are skipped, and anything after the number is ignored.
+template<std::integral T = long>
+T parse_int(std::string_view s) {
+    while (!s.empty() && s.front() == ' ') {
+        s.remove_prefix(1);
+    }
+    if (!s.empty() && s.front() == '+') {
+        s.remove_prefix(1);
+    }
+    T value{};
+    auto const [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec == std::errc::invalid_argument) {
+        throw std::invalid_argument("not an integer: " + std::string(s));
+    } else if (ec == std::errc::result_out_of_range) {
+        throw std::out_of_range("integer out of range: " + std::string(s));
+    }
+    return value;
+}
+
+// Reads the rest of the stream into one contiguous buffer, in large blocks.
+inline std::string read_all(std::istream& is) {
+    std::string input;
+    std::array<char, 1 << 16> chunk{};
+    while (auto const n = is.rdbuf()->sgetn(chunk.data(), chunk.size())) {
+        input.append(chunk.data(), n);
+    }
+    return input;
+}
+
+// Splits a buffer into lines, like repeated std::getline. The views point into the buffer.
+inline std::vector<std::string_view> split_lines(std::string_view input) {
+    std::vector<std::string_view> lines;
+    while (!input.empty()) {
+        size_t const eol = std::min(input.find('\n'), input.size());
+        lines.push_back(input.substr(0, eol));
+        input.remove_prefix(std::min(eol + 1, input.size()));
+    }
+    return lines;
+}
+
+// Calls f(line) for every line of the stream, like a std::getline loop, but reads the stream in
+// large blocks and hands out views into them. Only one block and one partial line are kept.
+template<class F>
+requires std::invocable<F&, std::string_view>
+void for_each_line(std::istream& is, F&& f) {
+    std::string buffer;
+    std::array<char, 1 << 16> chunk{};
+    while (auto const n = is.rdbuf()->sgetn(chunk.data(), chunk.size())) {
+        buffer.append(chunk.data(), n);
+        std::string_view rest = buffer;
+        for (size_t eol; (eol = rest.find('\n')) != std::string_view::npos; ) {
+            f(rest.substr(0, eol));
+            rest.remove_prefix(eol + 1);
+        }
+        buffer.erase(0, buffer.size() - rest.size());
+    }
+    if (!buffer.empty()) {
+        f(std::string_view{buffer});
+    }
+}